@@ -12,11 +12,14 @@ CONFIG += c++17
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
-    localsearch.cpp
+    localsearch.cpp \
+    batchsolver.cpp
 
 HEADERS += \
     mainwindow.h \
-    localsearch.h
+    localsearch.h \
+    batchsolver.h \
+    constraints.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,201 @@
+#include "batchsolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTextStream>
+
+QList<QList<QPoint>> BatchSolver::loadBoards(const QString &path, QList<int> *rejectedLines) {
+    QList<QList<QPoint>> boards;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return boards;
+    }
+
+    static QRegularExpression regExpSpace {"\\s+"};
+
+    QTextStream in(&file);
+    int line = 0;
+    while (!in.atEnd()) {
+        line++;
+        QStringList positions = in.readLine().split(regExpSpace, Qt::SkipEmptyParts);
+        if (positions.isEmpty()) {
+            continue;
+        }
+
+        // Reject whole row on any malformed position, so a corrupted row is never solved as a different board
+        QList<QPoint> queens;
+        bool valid = true;
+        for (auto &position : positions) {
+            QStringList coords = position.split(',');
+            bool okX = false;
+            bool okY = false;
+            int x = coords.size() == 2 ? coords[0].toInt(&okX) : -1;
+            int y = coords.size() == 2 ? coords[1].toInt(&okY) : -1;
+
+            if (!okX || !okY || x < 0 || y < 0) {
+                valid = false;
+                break;
+            }
+            queens.push_back({x, y});
+        }
+
+        if (valid) {
+            boards.push_back(queens);
+        } else if (rejectedLines != nullptr) {
+            rejectedLines->push_back(line);
+        }
+    }
+
+    return boards;
+}
+
+LocalSearch::State BatchSolver::solve(const Job &job) {
+    LocalSearch::randGen.seed(job.seed);
+
+    QList<QPoint> queens = job.queens;
+    const Params &p = job.params;
+    const LocalSearch::Constraints &c = job.constraints;
+
+    switch (job.algorithm) {
+        case Algorithm::HillClimbing:
+            return LocalSearch::hillClimb(job.boardSize, queens, p.equivalentMoves, c);
+        case Algorithm::SimulatedAnnealing: {
+            int tempStart = p.tempStart;
+            return LocalSearch::simulatedAnnealing(job.boardSize, queens, tempStart, p.tempChange, c);
+        }
+        case Algorithm::LocalBeamSearch:
+            return LocalSearch::localBeam(job.boardSize, queens, p.nStates, p.maxIters, c);
+        case Algorithm::GeneticAlgorithm:
+            return LocalSearch::genetic(job.boardSize, queens, p.populationSize, p.elitePerc, p.crossProb, p.mutationProb, p.generations, c);
+        case Algorithm::Backtracking:
+            return LocalSearch::backtrack(job.boardSize, queens, c);
+    }
+
+    return {queens, LocalSearch::calcHeuristics(job.boardSize, queens, c)};
+}
+
+BatchSolver::Metrics BatchSolver::solveBatch(const QList<Job> &jobs, const std::function<void(const Result &)> &onResult, int threads) {
+    Metrics metrics;
+    metrics.jobs = jobs.size();
+
+    // Reject invalid jobs upfront, before any job is solved
+    for (int i = 0; i < jobs.size(); i++) {
+        if (!jobs[i].constraints.isValid()) {
+            throw std::invalid_argument("Job " + std::to_string(i) + " has unsupported attack set " + std::to_string(jobs[i].constraints.attacks));
+        }
+    }
+
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threads = std::max(1, std::min(threads, jobs.size()));
+    metrics.threads = threads;
+
+    // Each worker owns a queue, jobs are dealt round-robin since their durations are unknown upfront
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<int> jobs;
+    };
+    std::vector<WorkerQueue> queues(threads);
+    for (int i = 0; i < jobs.size(); i++) {
+        queues[i % threads].jobs.push_back(i);
+    }
+
+    std::mutex resultMutex;
+    std::atomic<int> steals{0};
+
+    // First exception thrown by a job or callback, rethrown once all workers have stopped
+    std::exception_ptr error;
+    std::atomic<bool> failed{false};
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto work = [&](int worker) {
+        while (!failed) {
+            int job = -1;
+
+            // Take next job from own queue
+            {
+                WorkerQueue &own = queues[worker];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.jobs.empty()) {
+                    job = own.jobs.front();
+                    own.jobs.pop_front();
+                }
+            }
+
+            // Steal from the opposite end of other workers' queues (the job its owner would reach last)
+            for (int i = 1; job < 0 && i < threads; i++) {
+                WorkerQueue &victim = queues[(worker + i) % threads];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.jobs.empty()) {
+                    job = victim.jobs.back();
+                    victim.jobs.pop_back();
+                    steals++;
+                }
+            }
+
+            // Exit if all queues are empty (jobs never spawn new jobs)
+            if (job < 0) {
+                break;
+            }
+
+            try {
+                QElapsedTimer jobTimer;
+                jobTimer.start();
+                LocalSearch::State state = solve(jobs[job]);
+                Result result = {job, worker, state, jobTimer.nsecsElapsed() / 1e9};
+
+                // Report in completion order
+                std::lock_guard<std::mutex> lock(resultMutex);
+                metrics.busySeconds += result.seconds;
+                if (state.heuristics == 0) {
+                    metrics.solved++;
+                }
+                if (onResult) {
+                    onResult(result);
+                }
+            } catch (...) {
+                // Exceptions can not leave a thread, keep the first one and stop all workers
+                std::lock_guard<std::mutex> lock(resultMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back(work, i);
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    metrics.steals = steals;
+    metrics.wallSeconds = timer.nsecsElapsed() / 1e9;
+    if (metrics.wallSeconds > 0.0) {
+        metrics.jobsPerSecond = metrics.jobs / metrics.wallSeconds;
+        metrics.utilization = metrics.busySeconds / (metrics.wallSeconds * threads);
+    }
+
+    return metrics;
+}
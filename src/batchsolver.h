@@ -0,0 +1,70 @@
+#pragma once
+
+#include "localsearch.h"
+
+#include <functional>
+#include <QList>
+#include <QPoint>
+#include <QString>
+
+namespace BatchSolver {
+    enum Algorithm { HillClimbing, SimulatedAnnealing, LocalBeamSearch, GeneticAlgorithm, Backtracking };
+
+    // Algorithm parameters (defaults match user interface defaults), only those of job's algorithm are used
+    struct Params {
+        // Hill Climbing
+        int equivalentMoves = 5;
+        // Simulated Annealing
+        int tempStart = 10000;
+        int tempChange = 5;
+        // Local Beam Search
+        int nStates = 5;
+        int maxIters = 1000;
+        // Genetic Algorithm
+        int populationSize = 100;
+        int elitePerc = 20;
+        double crossProb = 0.7;
+        double mutationProb = 0.05;
+        int generations = 1000;
+    };
+
+    struct Job {
+        int boardSize = 8;
+        QList<QPoint> queens = {};
+        Algorithm algorithm = Algorithm::HillClimbing;
+        Params params = {};
+        unsigned int seed = 0;
+        LocalSearch::Constraints constraints = {};
+    };
+
+    struct Result {
+        int job; // Index into submitted jobs
+        int worker;
+        LocalSearch::State state;
+        double seconds;
+    };
+
+    struct Metrics {
+        int jobs = 0;
+        int solved = 0; // Jobs finished with heuristics = 0
+        int threads = 0;
+        int steals = 0; // Jobs taken from another worker's queue
+        double wallSeconds = 0.0;
+        double busySeconds = 0.0; // Sum of all job durations
+        double jobsPerSecond = 0.0;
+        double utilization = 0.0; // Busy time over available thread time
+    };
+
+    // Load start configurations, one board per row as space-separated "x,y" queen positions,
+    // rows with malformed or negative positions are skipped and their (1-based) line numbers reported
+    QList<QList<QPoint>> loadBoards(const QString &path, QList<int> *rejectedLines = nullptr);
+
+    // Solve single job on calling thread (seeds calling thread's generator)
+    LocalSearch::State solve(const Job &job);
+
+    // Solve all jobs on a work-stealing thread pool (0 threads = hardware concurrency),
+    // results are passed to callback in completion order (one at a time),
+    // throws std::invalid_argument before solving if any job has invalid constraints,
+    // first exception thrown by a job or callback stops remaining jobs and is rethrown after workers finish
+    Metrics solveBatch(const QList<Job> &jobs, const std::function<void(const Result &)> &onResult, int threads = 0);
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdlib>
+#include <vector>
+#include <QList>
+#include <QPoint>
+
+namespace LocalSearch {
+    // Attack sets, combinable as flags
+    enum Attack {
+        Rook = 1, // Same row or column
+        Bishop = 2, // Diagonal
+        Knight = 4, // Knight jump
+        Queen = Rook | Bishop,
+        SuperQueen = Queen | Knight
+    };
+
+    // Board constraints (default is classic N-Queen problem)
+    struct Constraints {
+        int attacks = Attack::Queen;
+        QList<QPoint> fixed; // Queens that can not be moved (N-Queen completion), added to start queens if missing
+        QList<QPoint> blocked; // Cells no queen may be placed on
+
+        // Attack set must be a non-empty combination of Rook, Bishop and Knight
+        bool isValid() const {
+            return attacks > 0 && attacks <= (Attack::Rook | Attack::Bishop | Attack::Knight);
+        }
+
+        bool isClassic() const {
+            return attacks == Attack::Queen && fixed.isEmpty() && blocked.isEmpty();
+        }
+    };
+
+    // Cell flags of constrained boards
+    enum Cell : unsigned char { CellBlocked = 1, CellFixed = 2 };
+
+    // Fill cell table (boardSize * boardSize flags) of constrained board, reuses storage once sized
+    inline void buildCells(int boardSize, const Constraints &constraints, std::vector<unsigned char> &cells) {
+        cells.assign(static_cast<size_t>(boardSize) * boardSize, 0);
+        auto mark = [&](const QList<QPoint> &points, Cell flag) {
+            for (auto &cell : points) {
+                if (cell.x() >= 0 && cell.x() < boardSize && cell.y() >= 0 && cell.y() < boardSize) {
+                    cells[cell.y() * boardSize + cell.x()] |= flag;
+                }
+            }
+        };
+        mark(constraints.blocked, CellBlocked);
+        mark(constraints.fixed, CellFixed);
+    }
+
+    // Compile-time constraint policy, unconstrained models compile down to plain attack checks
+    template<int Attacks, bool Constrained>
+    class Model {
+    public:
+        static constexpr int attacks = Attacks;
+
+        // Constrained models read cell table built by buildCells (owned by caller, must outlive model)
+        explicit Model(int boardSize, const unsigned char *cells = nullptr) : size(boardSize), cells(cells) {}
+
+        int boardSize() const { return size; }
+
+        bool contains(QPoint cell) const {
+            return cell.x() >= 0 && cell.x() < size && cell.y() >= 0 && cell.y() < size;
+        }
+
+        bool isBlocked(QPoint cell) const {
+            if constexpr (Constrained) {
+                return contains(cell) && (cells[cell.y() * size + cell.x()] & CellBlocked);
+            } else {
+                return false;
+            }
+        }
+
+        bool isFixed(QPoint cell) const {
+            if constexpr (Constrained) {
+                return contains(cell) && (cells[cell.y() * size + cell.x()] & CellFixed);
+            } else {
+                return false;
+            }
+        }
+
+        static bool threatens(QPoint queen1, QPoint queen2) {
+            int dx = abs(queen1.x() - queen2.x());
+            int dy = abs(queen1.y() - queen2.y());
+
+            if constexpr ((Attacks & Attack::Rook) != 0) {
+                if (dx == 0 || dy == 0) { // Same column or row
+                    return true;
+                }
+            }
+            if constexpr ((Attacks & Attack::Bishop) != 0) {
+                if (dx == dy) { // Diagonal
+                    return true;
+                }
+            }
+            if constexpr ((Attacks & Attack::Knight) != 0) {
+                if (dx * dy == 2) { // 1 + 2 jump
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        int size;
+        const unsigned char *cells;
+    };
+};
@@ -1,82 +1,416 @@
 #include "localsearch.h"
 
 #include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+void LocalSearch::Population::reserve(int capacity, int queensPerState) {
+    if (queensPerState != stride) {
+        stride = queensPerState;
+        count = 0;
+
+        // Queen storage must match state capacity for new stride
+        if (queenData.size() != heuristicsData.size() * stride) {
+            grow(std::max(capacity, static_cast<int>(heuristicsData.size())));
+        }
+    }
+    if (capacity > this->capacity()) {
+        grow(capacity);
+    }
+}
 
-int LocalSearch::calcHeuristics(QList<QPoint> queens) {
+// Upper bound of queen slots reserved upfront per population (larger populations grow on demand)
+static const qint64 MAX_RESERVED_QUEENS = 1 << 24;
+
+// Worst-case states clamped to reservable capacity (computed in 64 bits, never overflows)
+static int reservableStates(qint64 states, int queensPerState) {
+    qint64 limit = MAX_RESERVED_QUEENS / std::max(1, queensPerState);
+    return static_cast<int>(std::max<qint64>(1, std::min(states, limit)));
+}
+
+// Local beam generation holds at most all moves of nStates best states
+static int beamCapacity(int nStates, int queensPerState, int boardSize) {
+    qint64 states = static_cast<qint64>(std::max(1, nStates)) * queensPerState * 4 * std::max(1, boardSize - 1);
+    return reservableStates(states, queensPerState);
+}
+
+// Genetic generation holds elites (size / elitePerc) and nStates children, bounded by nStates * elitePerc / (elitePerc - 1)
+static int geneticCapacity(int nStates, int elitePerc, int queensPerState) {
+    qint64 states = elitePerc > 1 ? static_cast<qint64>(nStates) + nStates / (elitePerc - 1) + 1 : 2 * static_cast<qint64>(nStates);
+    return reservableStates(states, queensPerState);
+}
+
+// Doubled capacity for growth on demand
+static int nextCapacity(int count) {
+    qint64 capacity = std::max<qint64>(1, static_cast<qint64>(count) * 2);
+    if (capacity > std::numeric_limits<int>::max()) {
+        throw std::length_error("Population exceeds maximum number of states");
+    }
+    return static_cast<int>(capacity);
+}
+
+int LocalSearch::Population::capacity() const {
+    // Both buffers are always sized together (queenData = capacity * stride)
+    if (stride == 0) {
+        return static_cast<int>(heuristicsData.size());
+    }
+    return static_cast<int>(std::min(heuristicsData.size(), queenData.size() / stride));
+}
+
+void LocalSearch::Population::grow(int capacity) {
+    queenData.resize(static_cast<size_t>(capacity) * stride);
+    heuristicsData.resize(capacity);
+    order.resize(capacity);
+    allocs++;
+}
+
+int LocalSearch::Population::add(const QPoint *queens, int heuristics) {
+    if (count >= capacity()) {
+        grow(nextCapacity(count));
+    }
+
+    std::copy(queens, queens + stride, queenData.begin() + static_cast<size_t>(count) * stride);
+    heuristicsData[count] = heuristics;
+    return count++;
+}
+
+int LocalSearch::Population::add(const QList<QPoint> &queens, int heuristics) {
+    if (count >= capacity()) {
+        grow(nextCapacity(count));
+    }
+
+    std::copy(queens.begin(), queens.begin() + stride, queenData.begin() + static_cast<size_t>(count) * stride);
+    heuristicsData[count] = heuristics;
+    return count++;
+}
+
+LocalSearch::State LocalSearch::Population::state(int i) const {
+    State state;
+    state.queens.reserve(stride);
+    for (int q = 0; q < stride; q++) {
+        state.queens.push_back(queens(i)[q]);
+    }
+    state.heuristics = heuristics(i);
+
+    return state;
+}
+
+void LocalSearch::Population::rankBest(int n) {
+    auto first = order.begin();
+    auto last = order.begin() + count;
+    std::iota(first, last, 0);
+    std::shuffle(first, last, randGen); // Break ties randomly (keeps beam diversity)
+    std::partial_sort(first, first + std::min(n, count), last, [this](int a, int b) {
+        return heuristicsData[a] < heuristicsData[b];
+    });
+}
+
+void LocalSearch::Population::rankRandom() {
+    auto first = order.begin();
+    auto last = order.begin() + count;
+    std::iota(first, last, 0);
+    std::shuffle(first, last, randGen);
+}
+
+static bool isConstrained(const LocalSearch::Constraints &constraints) {
+    return !constraints.fixed.isEmpty() || !constraints.blocked.isEmpty();
+}
+
+// Call fn with model policy matching constraints (classic problem resolves to unconstrained queen model),
+// throws std::invalid_argument for attack sets that are not a combination of Rook, Bishop and Knight
+template<bool Constrained, typename Fn>
+static auto withAttacks(int boardSize, const LocalSearch::Constraints &constraints, const unsigned char *cells, Fn fn) {
+    using namespace LocalSearch;
+
+    switch (constraints.attacks) {
+        case Attack::Rook:
+            return fn(Model<Attack::Rook, Constrained>(boardSize, cells));
+        case Attack::Bishop:
+            return fn(Model<Attack::Bishop, Constrained>(boardSize, cells));
+        case Attack::Knight:
+            return fn(Model<Attack::Knight, Constrained>(boardSize, cells));
+        case Attack::Rook | Attack::Knight:
+            return fn(Model<Attack::Rook | Attack::Knight, Constrained>(boardSize, cells));
+        case Attack::Bishop | Attack::Knight:
+            return fn(Model<Attack::Bishop | Attack::Knight, Constrained>(boardSize, cells));
+        case Attack::SuperQueen:
+            return fn(Model<Attack::SuperQueen, Constrained>(boardSize, cells));
+        case Attack::Queen:
+            return fn(Model<Attack::Queen, Constrained>(boardSize, cells));
+        default:
+            throw std::invalid_argument("Unsupported attack set " + std::to_string(constraints.attacks));
+    }
+}
+
+// Model over given cell table (only read for constrained boards)
+template<typename Fn>
+static auto withModel(int boardSize, const LocalSearch::Constraints &constraints, const std::vector<unsigned char> &cells, Fn fn) {
+    if (!isConstrained(constraints)) {
+        return withAttacks<false>(boardSize, constraints, nullptr, fn);
+    }
+    return withAttacks<true>(boardSize, constraints, cells.data(), fn);
+}
+
+// Model over per-thread cell table rebuilt for this call (no allocation once sized)
+template<typename Fn>
+static auto withModel(int boardSize, const LocalSearch::Constraints &constraints, Fn fn) {
+    static thread_local std::vector<unsigned char> cells;
+    if (isConstrained(constraints)) {
+        LocalSearch::buildCells(boardSize, constraints, cells);
+    }
+    return withModel(boardSize, constraints, cells, fn);
+}
+
+// Cell table of populations, built on init and only reused by steps
+static const std::vector<unsigned char> &populationCells(int boardSize, const LocalSearch::Constraints &constraints, LocalSearch::Populations &states, bool init) {
+    if (isConstrained(constraints) && (init || states.cells.size() != static_cast<size_t>(boardSize) * boardSize)) {
+        LocalSearch::buildCells(boardSize, constraints, states.cells);
+    }
+    return states.cells;
+}
+
+using ClassicModel = LocalSearch::Model<LocalSearch::Attack::Queen, false>;
+
+static bool containsQueen(const QPoint *queens, int n, QPoint queen) {
+    return std::find(queens, queens + n, queen) != queens + n;
+}
+
+template<typename M>
+static int calcHeuristicsImpl(const M &model, const QPoint *queens, int n) {
     int h = 0;
-    for (int i = 0; i < queens.size(); i++) {
-        for (int j = i + 1; j < queens.size(); j++) {
-            if (threatens(queens[i], queens[j])) {
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            if (model.threatens(queens[i], queens[j])) {
                 h++;
             }
         }
+        // Queen on blocked cell is a violation as well
+        if (model.isBlocked(queens[i])) {
+            h++;
+        }
+    }
+
+    return h;
+}
+
+// Heuristics contribution of queen at index if it stood on cell (incremental conflict evaluation)
+template<typename M>
+static int conflictsImpl(const M &model, const QPoint *queens, int n, int index, QPoint cell) {
+    int h = model.isBlocked(cell) ? 1 : 0;
+    for (int j = 0; j < n; j++) {
+        if (j != index && model.threatens(queens[j], cell)) {
+            h++;
+        }
     }
 
     return h;
 }
 
+int LocalSearch::calcHeuristics(QList<QPoint> queens) {
+    std::vector<QPoint> queensData(queens.begin(), queens.end());
+    return calcHeuristicsImpl(ClassicModel(0), queensData.data(), queensData.size());
+}
+
+int LocalSearch::calcHeuristics(const QPoint *queens, int n) {
+    return calcHeuristicsImpl(ClassicModel(0), queens, n);
+}
+
+int LocalSearch::calcHeuristics(int boardSize, const QList<QPoint> &queens, const Constraints &constraints) {
+    std::vector<QPoint> queensData(queens.begin(), queens.end());
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return calcHeuristicsImpl(model, queensData.data(), queensData.size());
+    });
+}
+
 bool LocalSearch::threatens(QPoint queen1, QPoint queen2) {
-    return queen1.x() == queen2.x() // Same column
-        || queen1.y() == queen2.y() // Same row
-        || abs(queen1.x() - queen2.x()) == abs(queen1.y() - queen2.y()); // Diagonal
+    return ClassicModel::threatens(queen1, queen2);
 }
 
-QList<QList<QPoint>> LocalSearch::getAllowedStates(int boardSize, QList<QPoint> queens, int index) {
-    QPoint movingQueen = queens.at(index);
-    queens.removeAt(index);
+QList<QPoint> LocalSearch::prepareQueens(int boardSize, const QList<QPoint> &queens, const Constraints &constraints) {
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        QList<QPoint> prepared;
 
-    QList<QList<QPoint>> newQueensStates;
+        // Fixed queens first, then given queens on free cells
+        for (auto &queen : constraints.fixed) {
+            if (model.contains(queen) && !prepared.contains(queen)) {
+                prepared.push_back(queen);
+            }
+        }
+        for (auto &queen : queens) {
+            if (prepared.size() >= boardSize) {
+                break;
+            }
+            if (model.contains(queen) && !model.isBlocked(queen) && !prepared.contains(queen)) {
+                prepared.push_back(queen);
+            }
+        }
+
+        // Fill remaining queens on random free cells (if enough free cells exist)
+        int freeCells = 0;
+        for (int y = 0; y < boardSize; y++) {
+            for (int x = 0; x < boardSize; x++) {
+                if (!model.isBlocked({x, y}) && !prepared.contains({x, y})) {
+                    freeCells++;
+                }
+            }
+        }
 
-    // Create all possible moves
-    QList<QPoint> possibleMoves;
+        std::uniform_int_distribution<> distCell(0, boardSize - 1);
+        while (prepared.size() < boardSize && freeCells > 0) {
+            QPoint cell(distCell(randGen), distCell(randGen));
+            if (!model.isBlocked(cell) && !prepared.contains(cell)) {
+                prepared.push_back(cell);
+                freeCells--;
+            }
+        }
 
-    // Left
-    for (int x = movingQueen.x() - 1; x >= 0; x--) {
-        possibleMoves.push_back({x, movingQueen.y()});
+        return prepared;
+    });
+}
+
+// Start queens of public entry points, constrained boards always get all fixed queens and none on blocked cells
+static QList<QPoint> startQueens(int boardSize, const QList<QPoint> &queens, const LocalSearch::Constraints &constraints) {
+    if (!isConstrained(constraints)) {
+        return queens;
     }
-    // Right
-    for (int x = movingQueen.x() + 1; x < boardSize; x++) {
-        possibleMoves.push_back({x, movingQueen.y()});
+
+    // Keep queens (and their order) if they already satisfy constraints, e.g. when stepping
+    bool satisfied = queens.size() == boardSize;
+    for (auto &queen : constraints.fixed) {
+        satisfied = satisfied && queens.contains(queen);
     }
-    // Up
-    for (int y = movingQueen.y() - 1; y >= 0; y--) {
-        possibleMoves.push_back({movingQueen.x(), y});
+    for (auto &cell : constraints.blocked) {
+        satisfied = satisfied && !queens.contains(cell);
     }
-    // Down
-    for (int y = movingQueen.y() + 1; y < boardSize; y++) {
-        possibleMoves.push_back({movingQueen.x(), y});
+    if (satisfied) {
+        return queens;
     }
-    // Left-Up
-    for (int x = movingQueen.x() - 1, y = movingQueen.y() - 1; x >= 0 && y >= 0; x--, y--) {
-        possibleMoves.push_back({x, y});
+
+    return LocalSearch::prepareQueens(boardSize, queens, constraints);
+}
+
+// Calls fn(move) for each cell queen at index can move to (queen moves, not occupied by other queens, blocked nor fixed)
+template<typename M, typename Fn>
+static void forEachMove(const M &model, const QPoint *queens, int n, int index, Fn fn) {
+    // Left, Right, Up, Down, Left-Up, Left-Down, Right-Up, Right-Down
+    static const int directions[8][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+
+    QPoint movingQueen = queens[index];
+    if (model.isFixed(movingQueen)) {
+        return;
     }
-    // Left-Down
-    for (int x = movingQueen.x() - 1, y = movingQueen.y() + 1; x >= 0 && y < boardSize; x--, y++) {
-        possibleMoves.push_back({x, y});
+
+    int boardSize = model.boardSize();
+    for (auto &dir : directions) {
+        for (int x = movingQueen.x() + dir[0], y = movingQueen.y() + dir[1];
+             x >= 0 && x < boardSize && y >= 0 && y < boardSize;
+             x += dir[0], y += dir[1]) {
+            if (!model.isBlocked({x, y}) && !model.isFixed({x, y}) && !containsQueen(queens, n, {x, y})) {
+                fn(QPoint(x, y));
+            }
+        }
     }
-    // Right-Up
-    for (int x = movingQueen.x() + 1, y = movingQueen.y() - 1; x < boardSize && y >= 0; x++, y--) {
-        possibleMoves.push_back({x, y});
+}
+
+// Append all states reachable by moving one queen of given state (written directly into population)
+template<typename M>
+static void expandState(const M &model, const QPoint *queens, int heuristics, LocalSearch::Population &out) {
+    int n = out.queensPerState();
+    for (int i = 0; i < n; i++) {
+        // Heuristics without queen i, each move only adds conflicts of its new cell
+        int base = heuristics - conflictsImpl(model, queens, n, i, queens[i]);
+        forEachMove(model, queens, n, i, [&](QPoint move) {
+            int child = out.add(queens, base + conflictsImpl(model, queens, n, i, move));
+            out.queens(child)[i] = move;
+        });
     }
-    // Right-Down
-    for (int x = movingQueen.x() + 1, y = movingQueen.y() + 1; x < boardSize && y < boardSize; x++, y++) {
-        possibleMoves.push_back({x, y});
+}
+
+// Fill current population with nStates random neighbours of queens (next population is used as scratch)
+template<typename M>
+static void initPopulation(const M &model, QList<QPoint> &queens, int nStates, LocalSearch::Populations &states) {
+    // Sets queens per state (keeps larger capacity reserved by caller)
+    states.reserve(reservableStates(nStates, queens.size()), queens.size());
+
+    // Perform all possible moves on all queens and calculate their heuristics
+    states.current.clear();
+    states.current.add(queens, 0);
+    states.current.heuristics(0) = calcHeuristicsImpl(model, states.current.queens(0), queens.size());
+    states.next.clear();
+    expandState(model, states.current.queens(0), states.current.heuristics(0), states.next);
+
+    // Select random states
+    states.current.clear();
+    states.next.rankRandom();
+    for (int i = 0; i < nStates && i < states.next.size(); i++) {
+        int state = states.next.ranked(i);
+        states.current.add(states.next.queens(state), states.next.heuristics(state));
     }
+}
 
-    // Filter by already contained
-    for (auto &move : possibleMoves) {
-        if (!queens.contains(move)) {
+QList<QList<QPoint>> LocalSearch::getAllowedStates(int boardSize, QList<QPoint> queens, int index, const Constraints &constraints) {
+    QList<QList<QPoint>> newQueensStates;
+
+    std::vector<QPoint> queensData(queens.begin(), queens.end());
+    queens.removeAt(index);
+
+    // Create all possible moves (filtered by already contained)
+    withModel(boardSize, constraints, [&](const auto &model) {
+        forEachMove(model, queensData.data(), queensData.size(), index, [&](QPoint move) {
             newQueensStates.push_back(queens);
             newQueensStates.last().push_back(move);
-        }
-    }
+        });
+        return 0;
+    });
 
     return newQueensStates;
 }
 
-LocalSearch::State LocalSearch::hillClimb(int boardSize, QList<QPoint> &queens, int equivalentMoves) {
-    State prevState = {queens, std::numeric_limits<int>::max()};
-    State state;
+template<typename M>
+static LocalSearch::State hillClimbStepImpl(const M &model, const QList<QPoint> &queens) {
+    std::vector<QPoint> queensData(queens.begin(), queens.end());
+    int n = queensData.size();
+    int h = calcHeuristicsImpl(model, queensData.data(), n);
+
+    // Perform all possible moves on all queens and evaluate their heuristics incrementally,
+    // keep a random one of all minimal heuristics moves (reservoir sampling)
+    int minHeuristics = std::numeric_limits<int>::max();
+    int minCount = 0;
+    int minIndex = -1;
+    QPoint minMove;
+
+    for (int i = 0; i < n; i++) {
+        int base = h - conflictsImpl(model, queensData.data(), n, i, queensData[i]);
+        forEachMove(model, queensData.data(), n, i, [&](QPoint move) {
+            int moveHeuristics = base + conflictsImpl(model, queensData.data(), n, i, move);
+            if (moveHeuristics < minHeuristics) {
+                minHeuristics = moveHeuristics;
+                minCount = 0;
+            }
+            if (moveHeuristics == minHeuristics
+                    && std::uniform_int_distribution<>(0, minCount++)(LocalSearch::randGen) == 0) {
+                minIndex = i;
+                minMove = move;
+            }
+        });
+    }
+
+    // Stay if no queen can move
+    if (minIndex < 0) {
+        return {queens, h};
+    }
+
+    QList<QPoint> newQueens = queens;
+    newQueens.replace(minIndex, minMove);
+    return {newQueens, minHeuristics};
+}
+
+template<typename M>
+static LocalSearch::State hillClimbImpl(const M &model, QList<QPoint> &queens, int equivalentMoves) {
+    LocalSearch::State prevState = {queens, std::numeric_limits<int>::max()};
+    LocalSearch::State state;
 
     int steps = 0;
     int equalHeuristicsCount = 0;
@@ -84,7 +418,7 @@ LocalSearch::State LocalSearch::hillClimb(int boardSize, QList<QPoint> &queens,
     // Try to find global optimum (heuristics = 0)
     while (prevState.heuristics != 0) {
         steps++;
-        state = hillClimbStep(boardSize, prevState.queens);
+        state = hillClimbStepImpl(model, prevState.queens);
 
         // Exit if heuristics higher than previous heuristics (found local optimum)
         if (state.heuristics > prevState.heuristics) {
@@ -110,231 +444,477 @@ LocalSearch::State LocalSearch::hillClimb(int boardSize, QList<QPoint> &queens,
     return state;
 }
 
-LocalSearch::State LocalSearch::hillClimbStep(int boardSize, QList<QPoint> &queens) {
-    QList<State> moveStates;
+LocalSearch::State LocalSearch::hillClimb(int boardSize, QList<QPoint> &queens, int equivalentMoves, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return hillClimbImpl(model, start, equivalentMoves);
+    });
+}
 
-    // Perform all possible moves on all queens and calculate their heuristics
-    for (int i = 0; i < queens.size(); i++) {
-        for (auto &newQueens : getAllowedStates(boardSize, queens, i)) {
-            moveStates.push_back({newQueens, calcHeuristics(newQueens)});
-        }
+LocalSearch::State LocalSearch::hillClimbStep(int boardSize, QList<QPoint> &queens, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return hillClimbStepImpl(model, start);
+    });
+}
+
+template<typename M>
+static LocalSearch::State simulatedAnnealingStepImpl(const M &model, const QList<QPoint> &queens, int &temp, int tempChange) {
+    std::vector<QPoint> queensData(queens.begin(), queens.end());
+    int n = queensData.size();
+    LocalSearch::State state = {queens, calcHeuristicsImpl(model, queensData.data(), n)};
+
+    // Exit if temperature at minimum
+    if  (temp <= 0) {
+        return state;
     }
 
-    // Find minimal heuristics state (all if multiple of same minimal value)
-    State minState = *std::min_element(moveStates.begin(), moveStates.end());
-    QList<State> minStates;
-    for (auto &moveState : moveStates) {
-        if (moveState.heuristics == minState.heuristics) {
-            minStates.push_back(moveState);
+    // Count all possible moves on all queens
+    int moves = 0;
+    for (int i = 0; i < n; i++) {
+        forEachMove(model, queensData.data(), n, i, [&](QPoint /*move*/) { moves++; });
+    }
+
+    // Select a random move
+    if (moves > 0) {
+        int selectedMove = std::uniform_int_distribution<>(0, moves - 1)(LocalSearch::randGen);
+        int randIndex = -1;
+        QPoint randMove;
+        for (int i = 0; i < n && randIndex < 0; i++) {
+            forEachMove(model, queensData.data(), n, i, [&](QPoint move) {
+                if (selectedMove-- == 0) {
+                    randIndex = i;
+                    randMove = move;
+                }
+            });
+        }
+
+        // Select random state if lower heuristics or by probability
+        int randStateHeuristics = state.heuristics
+            - conflictsImpl(model, queensData.data(), n, randIndex, queensData[randIndex])
+            + conflictsImpl(model, queensData.data(), n, randIndex, randMove);
+        int deltaHeuristics = randStateHeuristics - state.heuristics;
+        if (deltaHeuristics < 0 || exp(-deltaHeuristics / static_cast<double>(temp)) > LocalSearch::distProbability(LocalSearch::randGen)) {
+            state.queens.replace(randIndex, randMove);
+            state.heuristics = randStateHeuristics;
         }
     }
 
-    // Select random minimal heuristics state
-    QList<State> states;
-    std::sample(minStates.begin(), minStates.end(), std::back_inserter(states), 1, randGen);
+    temp -= tempChange;
 
-    return states[0];
+    return state;
 }
 
-LocalSearch::State LocalSearch::simulatedAnnealing(int boardSize, QList<QPoint> &queens, int &tempStart, int tempChange) {
-    State state = {queens, std::numeric_limits<int>::max()};
+template<typename M>
+static LocalSearch::State simulatedAnnealingImpl(const M &model, QList<QPoint> &queens, int &tempStart, int tempChange) {
+    LocalSearch::State state = {queens, std::numeric_limits<int>::max()};
     int steps = 0;
 
     // Try to find global optimum (heuristics = 0)
     while (state.heuristics != 0 && tempStart > 0) {
         steps++;
-        state = simulatedAnnealingStep(boardSize, state.queens, tempStart, tempChange);
+        state = simulatedAnnealingStepImpl(model, state.queens, tempStart, tempChange);
     }
 
     state.steps = steps;
     return state;
 }
 
-LocalSearch::State LocalSearch::simulatedAnnealingStep(int boardSize, QList<QPoint> &queens, int &temp, int tempChange) {
-    State state = {queens, calcHeuristics(queens)};
+LocalSearch::State LocalSearch::simulatedAnnealing(int boardSize, QList<QPoint> &queens, int &tempStart, int tempChange, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return simulatedAnnealingImpl(model, start, tempStart, tempChange);
+    });
+}
 
-    // Exit if temperature at minimum
-    if  (temp <= 0) {
-        return state;
-    }
+LocalSearch::State LocalSearch::simulatedAnnealingStep(int boardSize, QList<QPoint> &queens, int &temp, int tempChange, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return simulatedAnnealingStepImpl(model, start, temp, tempChange);
+    });
+}
 
-    // Perform all possible moves on all queens
-    QList<QList<QPoint>> moveStates;
-    for (int i = 0; i < queens.size(); i++) {
-        moveStates.append(getAllowedStates(boardSize, queens, i));
+template<typename M>
+static void localBeamStepImpl(const M &model, LocalSearch::Populations &states, int nStates) {
+    LocalSearch::Population &current = states.current;
+    LocalSearch::Population &next = states.next;
+    next.clear();
+
+    // Nothing to expand
+    if (current.size() == 0) {
+        return;
     }
 
-    // Select a random move
-    QList<QList<QPoint>> randStates;
-    std::sample(moveStates.begin(), moveStates.end(), std::back_inserter(randStates), 1, randGen);
-    QList<QPoint> randState = randStates.first();
-
-    // Select random state if lower heuristics or by probability
-    int randStateHeuristics = calcHeuristics(randState);
-    int deltaHeuristics = randStateHeuristics - state.heuristics;
-    if (deltaHeuristics < 0) {
-        state = {randState, randStateHeuristics};
-    } else {
-        double probability = exp(-deltaHeuristics / static_cast<double>(temp));
-        if (probability > distProbability(randGen)) {
-            state = {randState, randStateHeuristics};
-        }
+    // Sort by heuristics (only nStates best states are needed)
+    int best = std::min(std::max(1, nStates), current.size());
+    current.rankBest(best);
+
+    // Exit if found result
+    if (current.heuristics(current.ranked(0)) == 0) {
+        next.add(current.queens(current.ranked(0)), 0);
+        states.swap();
+        return;
     }
 
-    temp -= tempChange;
+    // Perform all possible moves on all queens of nStates best states and calculate their heuristics
+    for (int i = 0; i < best; i++) {
+        int state = current.ranked(i);
+        expandState(model, current.queens(state), current.heuristics(state), next);
+    }
 
-    return state;
+    states.swap();
 }
 
-LocalSearch::State LocalSearch::localBeam(int boardSize, QList<QPoint> &queens, int nStates, int maxIters) {
-    QList<State> states = localBeamInit(boardSize, queens, nStates);
+template<typename M>
+static LocalSearch::State localBeamImpl(const M &model, QList<QPoint> &queens, int nStates, int maxIters) {
+    LocalSearch::Populations states;
+    states.reserve(beamCapacity(nStates, queens.size(), model.boardSize()), queens.size());
+    initPopulation(model, queens, nStates, states);
+    int initAllocations = states.allocations();
     int steps = 0;
 
     // Try to find global optimum (heuristics = 0)
-    while (states.size() > 1 && states[0].heuristics != 0 && maxIters > steps) {
+    while (states.current.size() > 1 && states.current.heuristics(0) != 0 && maxIters > steps) {
         steps++;
-        states = localBeamStep(boardSize, states, nStates);
+        localBeamStepImpl(model, states, nStates);
     }
 
-    states.first().steps = steps;
-    return states.first();
+    states.current.rankBest(1);
+    LocalSearch::State state = states.current.state(states.current.ranked(0));
+    state.steps = steps;
+    state.allocations = states.allocations() - initAllocations;
+    return state;
 }
 
-QList<LocalSearch::State> LocalSearch::localBeamInit(int boardSize, QList<QPoint> &queens, int nStates) {
-    // Perform all possible moves on all queens and calculate their heuristics
-    QList<State> moveStates;
-    for (int i = 0; i < queens.size(); i++) {
-        for (auto &newQueens : getAllowedStates(boardSize, queens, i)) {
-            moveStates.push_back({newQueens, calcHeuristics(newQueens)});
-        }
-    }
+LocalSearch::State LocalSearch::localBeam(int boardSize, QList<QPoint> &queens, int nStates, int maxIters, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return localBeamImpl(model, start, nStates, maxIters);
+    });
+}
 
-    // Select random states
-    QList<State> states;
-    std::sample(moveStates.begin(), moveStates.end(), std::back_inserter(states), nStates, randGen);
-    std::shuffle(states.begin(), states.end(), randGen); // Randomize (sample keeps relative order)
+void LocalSearch::localBeamInit(int boardSize, QList<QPoint> &queens, int nStates, Populations &states, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    states.reserve(beamCapacity(nStates, start.size(), boardSize), start.size());
+    withModel(boardSize, constraints, populationCells(boardSize, constraints, states, true), [&](const auto &model) {
+        initPopulation(model, start, nStates, states);
+        return 0;
+    });
+}
 
-    return states;
+void LocalSearch::localBeamStep(int boardSize, Populations &states, int nStates, const Constraints &constraints) {
+    withModel(boardSize, constraints, populationCells(boardSize, constraints, states, false), [&](const auto &model) {
+        localBeamStepImpl(model, states, nStates);
+        return 0;
+    });
 }
 
-QList<LocalSearch::State> LocalSearch::localBeamStep(int boardSize, QList<State> &states, int nStates) {
-    // Sort by heuristics
-    std::sort(states.begin(), states.end());
+template<typename M>
+static void geneticStepImpl(const M &model, LocalSearch::Populations &states, int nStates, int elitePerc, double crossProb, double mutationProb) {
+    using LocalSearch::randGen;
+    using LocalSearch::distProbability;
+
+    LocalSearch::Population &current = states.current;
+    LocalSearch::Population &next = states.next;
+    next.clear();
+
+    // Nothing to expand
+    if (current.size() == 0) {
+        return;
+    }
+
+    int n = current.queensPerState();
+    int elites = current.size() / elitePerc;
+
+    // Sort by heuristics (only best state and elites are needed)
+    current.rankBest(std::max(1, elites));
 
     // Exit if found result
-    if (states.first().heuristics == 0) {
-        return {states.first()};
+    if (current.heuristics(current.ranked(0)) == 0) {
+        next.add(current.queens(current.ranked(0)), 0);
+        states.swap();
+        return;
     }
 
-    // Select nStates best states
-    states = QList<State>(states.mid(0, nStates));
+    // Copy elites if population high enough to satisfy required elite percentage
+    for (int i = 0; i < elites; i++) {
+        int elite = current.ranked(i);
+        next.add(current.queens(elite), current.heuristics(elite));
+    }
 
-    // Perform all possible moves on all queens and calculate their heuristics
-    QList<State> newStates;
-    for (auto &state : states) {
-        for (int i = 0; i < state.queens.size(); i++) {
-            for (auto &newQueens : getAllowedStates(boardSize, state.queens, i)) {
-                newStates.push_back({newQueens, calcHeuristics(newQueens)});
+    std::uniform_int_distribution<> distQueen(0, n - 1);
+    std::uniform_int_distribution<> distParent1(0, current.size() - 1);
+    std::uniform_int_distribution<> distParent2(0, current.size() - 2);
+
+    for (int i = 0; i < nStates / 2 && i < current.size(); i++) {
+        // Choose 2 different parents with random selection, children start as their copies
+        int parent1 = distParent1(randGen);
+        int parent2 = distParent2(randGen);
+        if (parent2 >= parent1) {
+            parent2++;
+        }
+        int child1 = next.add(current.queens(parent1), current.heuristics(parent1));
+        int child2 = next.add(current.queens(parent2), current.heuristics(parent2));
+        QPoint *queens1 = next.queens(child1);
+        QPoint *queens2 = next.queens(child2);
+        bool changed = false;
+
+        // Uniform crossover by probablity
+        if (crossProb > distProbability(randGen)) {
+            // Exchange each queen couple by probability
+            // (fixed queens stay as every state contains them, so their exchange is always rejected)
+            for (int i = 0; i < n; i++) {
+                for (int j = i + 1; j < n; j++) {
+                    QPoint queen1 = queens1[i];
+                    QPoint queen2 = queens2[j];
+
+                    if (crossProb > distProbability(randGen)) {
+                        if (!containsQueen(queens1, n, queen2) && !containsQueen(queens2, n, queen1)) {
+                            queens1[i] = queen2;
+                            queens2[j] = queen1;
+                            changed = true;
+                        }
+                    }
+                }
             }
         }
+
+        for (QPoint *sel : {queens1, queens2}) {
+            // Mutate by probability (move random queen to random allowed cell)
+            if (mutationProb > distProbability(randGen)) {
+                int index = distQueen(randGen);
+                int moves = 0;
+                forEachMove(model, sel, n, index, [&](QPoint /*move*/) { moves++; });
+
+                if (moves > 0) {
+                    int selectedMove = std::uniform_int_distribution<>(0, moves - 1)(randGen);
+                    forEachMove(model, sel, n, index, [&](QPoint move) {
+                        if (selectedMove-- == 0) {
+                            sel[index] = move;
+                        }
+                    });
+                    changed = true;
+                }
+            }
+        }
+
+        // Heuristics only matter once crossover and mutation are done
+        if (changed) {
+            next.heuristics(child1) = calcHeuristicsImpl(model, queens1, n);
+            next.heuristics(child2) = calcHeuristicsImpl(model, queens2, n);
+        }
     }
 
-    return newStates;
+    states.swap();
 }
 
-LocalSearch::State LocalSearch::genetic(int boardSize, QList<QPoint> &queens, int nStates, int elitePerc, double crossProb, double mutationProb, int generations) {
-    QList<State> states = geneticInit(boardSize, queens, nStates);
+template<typename M>
+static LocalSearch::State geneticImpl(const M &model, QList<QPoint> &queens, int nStates, int elitePerc, double crossProb, double mutationProb, int generations) {
+    LocalSearch::Populations states;
+    states.reserve(geneticCapacity(nStates, elitePerc, queens.size()), queens.size());
+    initPopulation(model, queens, nStates, states);
+    int initAllocations = states.allocations();
     int steps = 0;
 
     // Try to find global optimum (heuristics = 0)
-    while (states.size() > 1 && states.first().heuristics != 0 && generations > steps) {
+    while (states.current.size() > 1 && states.current.heuristics(0) != 0 && generations > steps) {
         steps++;
-        states = geneticStep(boardSize, states, nStates, elitePerc, crossProb, mutationProb);
+        geneticStepImpl(model, states, nStates, elitePerc, crossProb, mutationProb);
     }
 
-    states.first().steps = steps;
-    return states.first();
+    states.current.rankBest(1);
+    LocalSearch::State state = states.current.state(states.current.ranked(0));
+    state.steps = steps;
+    state.allocations = states.allocations() - initAllocations;
+    return state;
 }
 
-QList<LocalSearch::State> LocalSearch::geneticInit(int boardSize, QList<QPoint> &queens, int nStates) {
-    // Perform all possible moves on all queens and calculate their heuristics
-    QList<State> moveStates;
-    for (int i = 0; i < queens.size(); i++) {
-        for (auto &newQueens : getAllowedStates(boardSize, queens, i)) {
-            moveStates.push_back({newQueens, calcHeuristics(newQueens)});
-        }
-    }
+LocalSearch::State LocalSearch::genetic(int boardSize, QList<QPoint> &queens, int nStates, int elitePerc, double crossProb, double mutationProb, int generations, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return geneticImpl(model, start, nStates, elitePerc, crossProb, mutationProb, generations);
+    });
+}
 
-    // Select random states
-    QList<State> states;
-    std::sample(moveStates.begin(), moveStates.end(), std::back_inserter(states), nStates, randGen);
-    std::shuffle(states.begin(), states.end(), randGen); // Randomize (sample keeps relative order)
+void LocalSearch::geneticInit(int boardSize, QList<QPoint> &queens, int nStates, Populations &states, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    states.reserve(geneticCapacity(nStates, 2, start.size()), start.size()); // Bound for any elitePerc >= 2
+    withModel(boardSize, constraints, populationCells(boardSize, constraints, states, true), [&](const auto &model) {
+        initPopulation(model, start, nStates, states);
+        return 0;
+    });
+}
 
-    return states;
+void LocalSearch::geneticStep(int boardSize, Populations &states, int nStates, int elitePerc, double crossProb, double mutationProb, const Constraints &constraints) {
+    withModel(boardSize, constraints, populationCells(boardSize, constraints, states, false), [&](const auto &model) {
+        geneticStepImpl(model, states, nStates, elitePerc, crossProb, mutationProb);
+        return 0;
+    });
 }
 
-QList<LocalSearch::State> LocalSearch::geneticStep(int boardSize, QList<State> &states, int nStates, int elitePerc, double crossProb, double mutationProb) {
-    // Sort by heuristics
-    std::sort(states.begin(), states.end());
+// Depth-first placement of non-fixed queens onto cells not attacked by already placed queens
+template<typename M>
+class Backtracker {
+public:
+    Backtracker(const M &model, int nQueens) : model(model), nQueens(nQueens) {}
 
-    // Exit if found result
-    if (states.first().heuristics == 0) {
-        return {states.first()};
+    std::vector<QPoint> placed;
+    int steps = 0;
+
+    bool solve() {
+        int boardSize = model.boardSize();
+
+        // Line attacks are checked in constant time through occupancy tables (fixed queens included)
+        if constexpr (LINE_ATTACKS) {
+            columns.assign(boardSize, 0);
+            rows.assign(boardSize, 0);
+            diagonals.assign(2 * boardSize - 1, 0);
+            antiDiagonals.assign(2 * boardSize - 1, 0);
+            for (auto &queen : placed) {
+                mark(queen, 1);
+            }
+        }
+
+        // Each row holds exactly one queen when rows attack and board is full, search row by row
+        if constexpr ((M::attacks & LocalSearch::Attack::Rook) != 0) {
+            if (nQueens == boardSize) {
+                rowTaken.assign(boardSize, false);
+                for (auto &queen : placed) {
+                    rowTaken[queen.y()] = true;
+                }
+                return placeRow(0);
+            }
+        }
+        return placeCell(0);
     }
 
-    QList<State> newStates;
+private:
+    // Knight jumps have no lines to index, those attack sets scan placed queens instead
+    static constexpr bool LINE_ATTACKS = (M::attacks & LocalSearch::Attack::Knight) == 0;
+
+    const M &model;
+    int nQueens;
+    std::vector<bool> rowTaken;
+    std::vector<char> columns;
+    std::vector<char> rows;
+    std::vector<char> diagonals; // x + y
+    std::vector<char> antiDiagonals; // x - y + boardSize - 1
+
+    void mark(QPoint queen, char value) {
+        if constexpr (LINE_ATTACKS) {
+            columns[queen.x()] = value;
+            rows[queen.y()] = value;
+            diagonals[queen.x() + queen.y()] = value;
+            antiDiagonals[queen.x() - queen.y() + model.boardSize() - 1] = value;
+        }
+    }
 
-    // Copy elites if population high enough to satisfy required elite percentage
-    int elites = states.size() / elitePerc;
-    for (int i = 0; i < elites; i++) {
-        newStates.push_back(states[i]);
+    void place(QPoint queen) {
+        steps++;
+        placed.push_back(queen);
+        mark(queen, 1);
     }
 
-    for (int i = 0; i < nStates / 2 && i < states.size(); i++) {
-        QList<State> selected = {};
+    void unplace() {
+        mark(placed.back(), 0);
+        placed.pop_back();
+    }
 
-        // Choose 2 parents with random selection
-        std::sample(states.begin(), states.end(), std::back_inserter(selected), 2, randGen);
-        std::shuffle(states.begin(), states.end(), randGen); // Randomize (sample keeps relative order)
+    bool canPlace(QPoint cell) const {
+        if (model.isBlocked(cell)) {
+            return false;
+        }
 
-        // Uniform crossover by probablity
-        if (crossProb > distProbability(randGen)) {
-            // Exchange each queen couple by probability
-            State &state1 = selected[0];
-            State &state2 = selected[1];
+        if constexpr (LINE_ATTACKS) {
+            // Occupied cells always share a line with their queen
+            if constexpr ((M::attacks & LocalSearch::Attack::Rook) != 0) {
+                if (columns[cell.x()] || rows[cell.y()]) {
+                    return false;
+                }
+            }
+            if constexpr ((M::attacks & LocalSearch::Attack::Bishop) != 0) {
+                if (diagonals[cell.x() + cell.y()] || antiDiagonals[cell.x() - cell.y() + model.boardSize() - 1]) {
+                    return false;
+                }
+            }
+            return true;
+        } else {
+            return !containsQueen(placed.data(), placed.size(), cell)
+                && conflictsImpl(model, placed.data(), placed.size(), -1, cell) == 0;
+        }
+    }
 
-            for (int i = 0; i < state1.queens.size(); i++) {
-                for (int j = i + 1; j < state2.queens.size(); j++) {
-                    QPoint queen1 = state1.queens[i];
-                    QPoint queen2 = state2.queens[j];
+    bool placeRow(int row) {
+        int boardSize = model.boardSize();
+        while (row < boardSize && rowTaken[row]) {
+            row++;
+        }
+        if (row == boardSize) {
+            return static_cast<int>(placed.size()) == nQueens;
+        }
 
-                    if (crossProb > distProbability(randGen)) {
-                        if (!state1.queens.contains(queen2) && !state2.queens.contains(queen1)) {
-                            state1.queens.replace(i, queen2);
-                            state2.queens.replace(j, queen1);
-                            state1.heuristics = calcHeuristics(state1.queens);
-                            state2.heuristics = calcHeuristics(state2.queens);
-                        }
-                    }
+        for (int x = 0; x < boardSize; x++) {
+            if (canPlace({x, row})) {
+                place({x, row});
+                if (placeRow(row + 1)) {
+                    return true;
                 }
+                unplace();
             }
         }
+        return false;
+    }
 
-        std::uniform_int_distribution<> distQueen(0, boardSize - 1);
-        for (auto &sel : selected) {
-            // Mutate by probability
-            if (mutationProb > distProbability(randGen)) {
-                QList<QList<QPoint>> allowedStates = getAllowedStates(boardSize, sel.queens, distQueen(randGen));
-                QList<QList<QPoint>> randStates;
-                std::sample(allowedStates.begin(), allowedStates.end(), std::back_inserter(randStates), 1, randGen);
-                QList<QPoint> randState = randStates.first();
+    bool placeCell(int cell) {
+        int boardSize = model.boardSize();
+        int remaining = nQueens - placed.size();
+        if (remaining == 0) {
+            return true;
+        }
 
-                sel = {randState, calcHeuristics(randState)};
+        // Stop if not enough cells left for remaining queens
+        for (; boardSize * boardSize - cell >= remaining; cell++) {
+            QPoint point(cell % boardSize, cell / boardSize);
+            if (canPlace(point)) {
+                place(point);
+                if (placeCell(cell + 1)) {
+                    return true;
+                }
+                unplace();
             }
         }
+        return false;
+    }
+};
+
+template<typename M>
+static LocalSearch::State backtrackImpl(const M &model, QList<QPoint> &queens, const LocalSearch::Constraints &constraints) {
+    Backtracker<M> backtracker(model, queens.size());
+
+    // Keep fixed queens, they must not attack each other
+    for (auto &queen : constraints.fixed) {
+        if (model.contains(queen) && !containsQueen(backtracker.placed.data(), backtracker.placed.size(), queen)) {
+            backtracker.placed.push_back(queen);
+        }
+    }
+    int fixedHeuristics = calcHeuristicsImpl(model, backtracker.placed.data(), backtracker.placed.size());
 
-        newStates.append({selected[0], selected[1]});
+    if (fixedHeuristics == 0 && backtracker.solve()) {
+        LocalSearch::State state = {QList<QPoint>(), 0, backtracker.steps};
+        for (auto &queen : backtracker.placed) {
+            state.queens.push_back(queen);
+        }
+        return state;
     }
 
-    return newStates;
+    // No solution exists, leave queens as they are
+    std::vector<QPoint> queensData(queens.begin(), queens.end());
+    return {queens, calcHeuristicsImpl(model, queensData.data(), queensData.size()), backtracker.steps};
+}
+
+LocalSearch::State LocalSearch::backtrack(int boardSize, QList<QPoint> &queens, const Constraints &constraints) {
+    QList<QPoint> start = startQueens(boardSize, queens, constraints);
+    return withModel(boardSize, constraints, [&](const auto &model) {
+        return backtrackImpl(model, start, constraints);
+    });
 }
@@ -1,42 +1,114 @@
 #pragma once
 
+#include "constraints.h"
+
 #include <random>
+#include <utility>
+#include <vector>
 #include <QList>
+#include <QPoint>
 
 namespace LocalSearch {
-    static std::mt19937 randGen = std::mt19937{std::random_device{}()};
-    static std::uniform_real_distribution<> distProbability(0.0, 1.0);
+    // Per-thread generators so independent instances can be solved in parallel (see BatchSolver)
+    inline thread_local std::mt19937 randGen = std::mt19937{std::random_device{}()};
+    inline thread_local std::uniform_real_distribution<> distProbability(0.0, 1.0);
 
     struct State {
         QList<QPoint> queens;
         int heuristics;
         int steps = 0;
+        int allocations = 0; // Population heap allocations after initialization (beam search and genetic only)
 
         bool operator<(const State &s) const {
             return heuristics < s.heuristics;
         }
     };
 
+    // Contiguous storage for states of equal queen count, reused between generations
+    class Population {
+    public:
+        // Preallocate storage for capacity states (counts as allocation if storage grows)
+        void reserve(int capacity, int queensPerState);
+        void clear() { count = 0; }
+
+        int size() const { return count; }
+        int queensPerState() const { return stride; }
+        int allocations() const { return allocs; }
+
+        QPoint *queens(int i) { return queenData.data() + static_cast<size_t>(i) * stride; }
+        const QPoint *queens(int i) const { return queenData.data() + static_cast<size_t>(i) * stride; }
+        int &heuristics(int i) { return heuristicsData[i]; }
+        int heuristics(int i) const { return heuristicsData[i]; }
+
+        // Append a copy of queens, returns index of new state (invalidates queens pointers if storage grows)
+        int add(const QPoint *queens, int heuristics);
+        int add(const QList<QPoint> &queens, int heuristics);
+        State state(int i) const;
+
+        // Order n best states first, ties in random order (partial sort of indices, states themselves are not moved)
+        void rankBest(int n);
+        // Order states randomly
+        void rankRandom();
+        // Index of state at given rank (after rankBest or rankRandom)
+        int ranked(int rank) const { return order[rank]; }
+
+    private:
+        std::vector<QPoint> queenData;
+        std::vector<int> heuristicsData;
+        std::vector<int> order;
+        int stride = 0;
+        int count = 0;
+        int allocs = 0;
+
+        int capacity() const;
+        void grow(int capacity);
+    };
+
+    // Double-buffered population, current generation is read while next is written, then swapped
+    struct Populations {
+        Population current;
+        Population next;
+        std::vector<unsigned char> cells; // Constraint cell table, built by init and reused by steps
+
+        void reserve(int capacity, int queensPerState) {
+            current.reserve(capacity, queensPerState);
+            next.reserve(capacity, queensPerState);
+        }
+        void swap() { std::swap(current, next); }
+        int allocations() const { return current.allocations() + next.allocations(); }
+    };
+
     // Calculate heuristics of queen positions (number of pairs of queens attacking each other)
     int calcHeuristics(QList<QPoint> queens);
+    int calcHeuristics(const QPoint *queens, int n);
+    // Constrained heuristics also count queens placed on blocked cells
+    int calcHeuristics(int boardSize, const QList<QPoint> &queens, const Constraints &constraints);
     // Checks if queens threaten each other
     bool threatens(QPoint queen1, QPoint queen2);
 
-    QList<QList<QPoint>> getAllowedStates(int boardSize, QList<QPoint> queens, int index);
+    // Start queens satisfying constraints (all fixed queens, valid given queens, random free cells up to board size)
+    QList<QPoint> prepareQueens(int boardSize, const QList<QPoint> &queens, const Constraints &constraints);
+
+    // Queens move like chess queens regardless of attack set, fixed queens never move and blocked cells are skipped
+    QList<QList<QPoint>> getAllowedStates(int boardSize, QList<QPoint> queens, int index, const Constraints &constraints = {});
 
-    // Algorithms
-    State hillClimb(int boardSize, QList<QPoint> &queens, int equivalentMoves);
-    State hillClimbStep(int boardSize, QList<QPoint> &queens);
+    // Algorithms (with fixed or blocked cells, start queens are first fitted with prepareQueens),
+    // all functions taking constraints throw std::invalid_argument for unsupported attack sets
+    State hillClimb(int boardSize, QList<QPoint> &queens, int equivalentMoves, const Constraints &constraints = {});
+    State hillClimbStep(int boardSize, QList<QPoint> &queens, const Constraints &constraints = {});
 
-    State simulatedAnnealing(int boardSize, QList<QPoint> &queens, int &tempStart, int tempChange);
-    State simulatedAnnealingStep(int boardSize, QList<QPoint> &queens, int &temp, int tempChange);
+    State simulatedAnnealing(int boardSize, QList<QPoint> &queens, int &tempStart, int tempChange, const Constraints &constraints = {});
+    State simulatedAnnealingStep(int boardSize, QList<QPoint> &queens, int &temp, int tempChange, const Constraints &constraints = {});
 
-    State localBeam(int boardSize, QList<QPoint> &queens, int nStates, int maxIters);
-    QList<State> localBeamInit(int boardSize, QList<QPoint> &queens, int nStates);
-    QList<State> localBeamStep(int boardSize, QList<State> &states, int nStates);
+    State localBeam(int boardSize, QList<QPoint> &queens, int nStates, int maxIters, const Constraints &constraints = {});
+    void localBeamInit(int boardSize, QList<QPoint> &queens, int nStates, Populations &states, const Constraints &constraints = {});
+    void localBeamStep(int boardSize, Populations &states, int nStates, const Constraints &constraints = {});
 
     // State = Chromosome, Queen = Gene, nState = Population
-    State genetic(int boardSize, QList<QPoint> &queens, int nStates, int elitePerc, double crossProb, double mutationProb, int generations);
-    QList<State> geneticInit(int boardSize, QList<QPoint> &queens, int nStates);
-    QList<State> geneticStep(int boardSize, QList<State> &states, int nStates, int elitePerc, double crossProb, double mutationProb);
+    State genetic(int boardSize, QList<QPoint> &queens, int nStates, int elitePerc, double crossProb, double mutationProb, int generations, const Constraints &constraints = {});
+    void geneticInit(int boardSize, QList<QPoint> &queens, int nStates, Populations &states, const Constraints &constraints = {});
+    void geneticStep(int boardSize, Populations &states, int nStates, int elitePerc, double crossProb, double mutationProb, const Constraints &constraints = {});
+
+    // Exact backtracking search, keeps fixed queens and places remaining ones (steps = placements tried)
+    State backtrack(int boardSize, QList<QPoint> &queens, const Constraints &constraints = {});
 };
@@ -255,6 +255,13 @@ void MainWindow::on_pushButtonRun_clicked() {
 
             state = LocalSearch::genetic(getBoardSize(), queens, populationSize, elitePerc, crossProb, mutationProb, generations);
 
+            queens = state.queens;
+            setupBoard();
+            break;
+        }
+        case Algorithm::Backtracking: {
+            state = LocalSearch::backtrack(getBoardSize(), queens);
+
             queens = state.queens;
             setupBoard();
             break;
@@ -13,7 +13,7 @@ class MainWindow : public QMainWindow {
 public:
     enum Placement { Random, TopRow };
     Q_ENUM(Placement)
-    enum Algorithm { HillClimbing, SimulatedAnnealing, LocalBeamSearch, GeneticAlgorithm };
+    enum Algorithm { HillClimbing, SimulatedAnnealing, LocalBeamSearch, GeneticAlgorithm, Backtracking };
     Q_ENUM(Algorithm)
 
     explicit MainWindow(QWidget *parent = nullptr);